@@ -0,0 +1,170 @@
+#include "vector.hpp"
+#include "recycling_allocator.hpp"
+#include "incremental_vector.hpp"
+#include "capacity_learning.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+
+using myvector::Vector;
+using myvector::RecyclingAllocator;
+
+static std::size_t allocations = 0;
+
+template<typename Base>
+struct CountingAllocator: Base {
+    using value_type = typename Base::value_type;
+
+    template<typename U>
+    struct rebind {
+        using other = CountingAllocator<typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+    };
+
+    CountingAllocator() = default;
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>& other): Base(other) {}
+
+    value_type* allocate(std::size_t n) {
+        ++allocations;
+        return Base::allocate(n);
+    }
+};
+
+template<typename Allocator>
+double BenchChurn(std::size_t rounds, std::size_t elems) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; ++round) {
+        Vector<int, Allocator> vec;
+        for (std::size_t idx = 0; idx < elems; ++idx) {
+            vec.push_back(static_cast<int>(idx));
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (double)rounds;
+}
+
+void Report(const char* name, std::size_t elems, double ns, double allocs) {
+    std::printf("%-10s %6zu elems: %10.1f ns/vector, %6.2f system allocs/vector\n", name, elems, ns, allocs);
+}
+
+void BenchRecycling() {
+    std::printf("\nBenchRecycling:\n");
+    const std::size_t sizes[] = {16, 256, 4096};
+    for (std::size_t elems : sizes) {
+        std::size_t rounds = (std::size_t(1) << 22) / elems;
+
+        allocations = 0;
+        double ns = BenchChurn<CountingAllocator<std::allocator<int>>>(rounds, elems);
+        Report("std", elems, ns, (double)allocations / (double)rounds);
+
+        myvector::reset_recycling_stats();
+        ns = BenchChurn<RecyclingAllocator<int>>(rounds, elems);
+        Report("recycling", elems, ns, (double)myvector::recycling_stats().misses / (double)rounds);
+    }
+    myvector::trim_recycling_cache();
+}
+
+template<typename Func>
+double TimeNs(std::size_t rounds, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; ++round) {
+        func();
+        asm volatile("" : : : "memory");
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (double)rounds;
+}
+
+void BenchExpressions() {
+    std::printf("\nBenchExpressions (a = b * c + d * 2.0):\n");
+    const std::size_t size = std::size_t(1) << 22;
+    const std::size_t rounds = 20;
+    Vector<double> a(size), b(size, 1.5), c(size, 2.5), d(size, -0.5);
+
+    double ns = TimeNs(rounds, [&] {
+        for (std::size_t idx = 0; idx < size; ++idx) {
+            a[idx] = b[idx] * c[idx] + d[idx] * 2.0;
+        }
+    });
+    std::printf("%-10s %10.3f ms\n", "loop", ns / 1e6);
+
+    ns = TimeNs(rounds, [&] { a = b * c + d * 2.0; });
+    std::printf("%-10s %10.3f ms\n", "expr", ns / 1e6);
+
+    ns = TimeNs(rounds, [&] { a.assign_parallel(b * c + d * 2.0); });
+    std::printf("%-10s %10.3f ms\n", "parallel", ns / 1e6);
+}
+
+template<typename Vec>
+void BenchPushLatency(const char* name, std::size_t count) {
+    std::vector<std::uint32_t> latencies(count);
+    Vec vec;
+    auto total_start = std::chrono::steady_clock::now();
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        auto start = std::chrono::steady_clock::now();
+        vec.push_back(static_cast<int>(idx));
+        auto stop = std::chrono::steady_clock::now();
+        latencies[idx] = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+    }
+    auto total_stop = std::chrono::steady_clock::now();
+
+    auto percentile = [&](double p) {
+        std::size_t pos = static_cast<std::size_t>(p * (double)(count - 1));
+        std::nth_element(latencies.begin(), latencies.begin() + (std::ptrdiff_t)pos, latencies.end());
+        return latencies[pos];
+    };
+    double total_ms = std::chrono::duration<double, std::milli>(total_stop - total_start).count();
+    std::uint32_t p50 = percentile(0.5);
+    std::uint32_t p999 = percentile(0.999);
+    std::uint32_t p99999 = percentile(0.99999);
+    std::uint32_t worst = *std::max_element(latencies.begin(), latencies.end());
+    std::printf("%-12s p50 %6u ns, p99.9 %6u ns, p99.999 %9u ns, max %10u ns, total %8.1f ms\n",
+                name, p50, p999, p99999, worst, total_ms);
+}
+
+void BenchIncremental() {
+    const std::size_t count = std::size_t(1) << 24;
+    std::printf("\nBenchIncremental (%zu push_back):\n", count);
+    BenchPushLatency<Vector<int>>("Vector", count);
+    BenchPushLatency<myvector::IncrementalVector<int>>("Incremental", count);
+}
+
+template<typename Vec>
+double BenchBuild(std::size_t rounds) {
+    return TimeNs(rounds, [] {
+        static std::size_t round = 0;
+        Vec vec;
+        std::size_t count = 900 + (round++ % 200);
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            vec.push_back(static_cast<int>(idx));
+        }
+    });
+}
+
+void BenchLearning() {
+    std::printf("\nBenchLearning (900..1100 elements per vector):\n");
+    const std::size_t rounds = 100000;
+    using Counting = CountingAllocator<std::allocator<int>>;
+
+    allocations = 0;
+    double ns = BenchBuild<Vector<int, Counting>>(rounds);
+    Report("Vector", 1000, ns, (double)allocations / (double)rounds);
+
+    allocations = 0;
+    ns = BenchBuild<myvector::LearnedVector<int, Counting>>(rounds);
+    Report("Learned", 1000, ns, (double)allocations / (double)rounds);
+}
+
+int main() {
+    BenchRecycling();
+    BenchExpressions();
+    BenchIncremental();
+    BenchLearning();
+
+    return 0;
+}
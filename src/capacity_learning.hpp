@@ -0,0 +1,326 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "vector.hpp"
+
+namespace myvector {
+
+// Per-call-site capacity learning. Every LearnedVector remembers where it was
+// constructed; when it is destroyed (or on record_size()) its final size goes
+// into a histogram kept per site in a thread-local table. Later LearnedVectors
+// from the same site reserve the learned percentile up front. Learned tables
+// can be dumped and loaded back, so a warmed profile can ship with a binary.
+
+struct CapacityLearningConfig {
+    double percentile = 0.9;
+    std::size_t min_samples = 8;
+};
+
+namespace learning {
+
+inline std::atomic<double> percentile{CapacityLearningConfig().percentile};
+inline std::atomic<std::size_t> min_samples{CapacityLearningConfig().min_samples};
+
+// file is the string from std::source_location, which is stable for the
+// program's lifetime, so keys compare and hash it by address.
+struct SiteKey {
+    std::string_view file;
+    std::uint_least32_t line;
+    std::uint_least32_t column;
+
+    bool operator==(const SiteKey& other) const noexcept {
+        return file.data() == other.file.data() && line == other.line && column == other.column;
+    }
+};
+
+struct SiteKeyHash {
+    std::size_t operator()(const SiteKey& key) const noexcept {
+        std::size_t hash = std::hash<const char*>()(key.file.data());
+        return hash ^ ((std::size_t(key.line) << 16) + key.column + (hash << 6) + (hash >> 2));
+    }
+};
+
+inline std::string SiteName(const SiteKey& key) {
+    return std::string(key.file) + ':' + std::to_string(key.line) + ':' + std::to_string(key.column);
+}
+
+// Final sizes bucketed by ceil(log2): bucket b holds sizes in (2^(b-1), 2^b]
+// (bucket 0 also holds 0), and 2^b is suggested for it, so learned
+// capacities stay powers of two and a size of exactly 2^b is not doubled.
+class SiteStats {
+    public:
+
+    static constexpr std::size_t kBuckets = 65;
+    static constexpr std::size_t kMaxCapacity = std::size_t(-1) / 2;
+
+    SiteStats(): counts_(), total_(0), preloaded_(0) {}
+
+    void Record(std::size_t size) noexcept {
+        ++counts_[size == 0 ? 0 : std::bit_width(size - 1)];
+        ++total_;
+    }
+
+    // Capacity covering the configured percentile of recorded sizes, or the
+    // preloaded value while there are too few samples.
+    std::size_t Suggest() const noexcept {
+        if (total_ == 0 || total_ < min_samples.load(std::memory_order_relaxed)) return preloaded_;
+
+        double wanted = percentile.load(std::memory_order_relaxed) * (double)total_;
+        std::uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+            seen += counts_[bucket];
+            if ((double)seen >= wanted) return bucket < 64 ? std::size_t(1) << bucket : kMaxCapacity;
+        }
+        return preloaded_;
+    }
+
+    std::uint64_t Samples() const noexcept {
+        return total_;
+    }
+
+    void Preload(std::size_t capacity) noexcept {
+        preloaded_ = capacity;
+    }
+
+    private:
+
+    std::uint64_t counts_[kBuckets];
+    std::uint64_t total_;
+    std::size_t preloaded_;
+};
+
+class Profile {
+    public:
+
+    Profile(): mutex_(), table_() {}
+
+    std::size_t Find(const std::string& site) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = table_.find(site);
+        return it == table_.end() ? 0 : it->second;
+    }
+
+    void Set(const std::string& site, std::size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        table_[site] = capacity;
+    }
+
+    std::map<std::string, std::size_t> Snapshot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::map<std::string, std::size_t>(table_.begin(), table_.end());
+    }
+
+    private:
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::size_t> table_;
+};
+
+inline Profile& GlobalProfile() {
+    static Profile profile;
+    return profile;
+}
+
+using SiteTable = std::unordered_map<SiteKey, SiteStats, SiteKeyHash>;
+
+inline SiteTable& LocalSites() {
+    thread_local SiteTable sites;
+    return sites;
+}
+
+// Bumped whenever the calling thread's table is cleared, so that cached
+// SiteStats pointers can tell they are stale.
+inline std::uint64_t& LocalGeneration() {
+    thread_local std::uint64_t generation = 0;
+    return generation;
+}
+
+inline SiteKey KeyOf(const std::source_location& loc) noexcept {
+    return SiteKey{loc.file_name(), loc.line(), loc.column()};
+}
+
+inline SiteStats& StatsOf(const std::source_location& loc) {
+    SiteKey key = KeyOf(loc);
+    SiteTable& sites = LocalSites();
+    auto it = sites.find(key);
+    if (it != sites.end()) return it->second;
+
+    SiteStats& stats = sites[key];
+    stats.Preload(GlobalProfile().Find(SiteName(key)));
+    return stats;
+}
+
+} // namespace learning
+
+inline void set_capacity_learning(const CapacityLearningConfig& config) noexcept {
+    learning::percentile.store(config.percentile, std::memory_order_relaxed);
+    learning::min_samples.store(config.min_samples, std::memory_order_relaxed);
+}
+
+// Forgets what the calling thread has learned. Loaded profiles are kept.
+inline void reset_capacity_learning() {
+    learning::LocalSites().clear();
+    ++learning::LocalGeneration();
+}
+
+// Writes one "file:line:column capacity" line per site: loaded entries,
+// overridden by what the calling thread has learned with enough samples.
+inline void dump_capacity_profile(std::ostream& out) {
+    std::map<std::string, std::size_t> table = learning::GlobalProfile().Snapshot();
+    std::size_t needed = learning::min_samples.load(std::memory_order_relaxed);
+    for (const auto& [key, stats] : learning::LocalSites()) {
+        if (stats.Samples() != 0 && stats.Samples() >= needed) {
+            table[learning::SiteName(key)] = stats.Suggest();
+        }
+    }
+    for (const auto& [site, capacity] : table) {
+        out << site << ' ' << capacity << '\n';
+    }
+}
+
+// Reads lines written by dump_capacity_profile. The entries apply to sites
+// that a thread has not looked up yet. Lines whose capacity is not a plain
+// decimal number up to SiteStats::kMaxCapacity are skipped. Returns the
+// number of entries read.
+inline std::size_t load_capacity_profile(std::istream& in) {
+    std::size_t loaded = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::size_t space = line.rfind(' ');
+        if (space == std::string::npos || space == 0) continue;
+        const char* first = line.data() + space + 1;
+        const char* last = line.data() + line.size();
+        std::size_t capacity = 0;
+        auto [end, err] = std::from_chars(first, last, capacity);
+        if (err != std::errc() || end != last || first == last || capacity > learning::SiteStats::kMaxCapacity) continue;
+        learning::GlobalProfile().Set(line.substr(0, space), capacity);
+        ++loaded;
+    }
+    return loaded;
+}
+
+// Vector that reserves the capacity learned for its construction site. The
+// final size is recorded when the vector is destroyed while it still owns a
+// buffer (so moved-from vectors are skipped), or earlier via record_size().
+template<typename T, typename Allocator = std::allocator<T>>
+class LearnedVector: public Vector<T, Allocator> {
+    public:
+
+    using base_type = Vector<T, Allocator>;
+    using typename base_type::allocator_type;
+    using typename base_type::size_type;
+
+    explicit LearnedVector(std::source_location site = std::source_location::current()):
+        base_type(),
+        site_(site),
+        recorded_(false),
+        stats_(nullptr),
+        table_(nullptr),
+        generation_(0)
+        {
+            Reserve(Stats().Suggest());
+        }
+
+    explicit LearnedVector(const allocator_type& alloc, std::source_location site = std::source_location::current()):
+        base_type(alloc),
+        site_(site),
+        recorded_(false),
+        stats_(nullptr),
+        table_(nullptr),
+        generation_(0)
+        {
+            Reserve(Stats().Suggest());
+        }
+
+    // Copies keep the site but never record: only the original vector
+    // reflects what the site builds.
+    LearnedVector(const LearnedVector& other):
+        base_type(other),
+        site_(other.site_),
+        recorded_(true),
+        stats_(nullptr),
+        table_(nullptr),
+        generation_(0) {}
+
+    LearnedVector(LearnedVector&& other) noexcept:
+        base_type(std::move(other)),
+        site_(other.site_),
+        recorded_(other.recorded_),
+        stats_(other.stats_),
+        table_(other.table_),
+        generation_(other.generation_) {}
+
+    ~LearnedVector() {
+        if (!recorded_ && this->capacity() != 0) {
+            try {
+                Stats().Record(this->size());
+            }
+            catch (...) {}
+        }
+    }
+
+    using base_type::operator=;
+
+    LearnedVector& operator=(const LearnedVector& other) {
+        base_type::operator=(other);
+        return *this;
+    }
+
+    LearnedVector& operator=(LearnedVector&& other)
+    noexcept(noexcept(std::declval<base_type&>() = std::declval<base_type&&>())) {
+        base_type::operator=(std::move(other));
+        return *this;
+    }
+
+    // Records the current size as this site's final size now; the destructor
+    // will not record it again.
+    void record_size() {
+        if (recorded_) return;
+        Stats().Record(this->size());
+        recorded_ = true;
+    }
+
+    std::source_location site() const noexcept {
+        return site_;
+    }
+
+    private:
+
+    // A suggestion is only a hint: one this allocator can never satisfy is
+    // dropped instead of making construction throw length_error.
+    void Reserve(size_type capacity) {
+        if (capacity < this->max_size()) this->reserve(capacity);
+    }
+
+    std::source_location site_;
+    bool recorded_;
+    learning::SiteStats* stats_;
+    learning::SiteTable* table_;
+    std::uint64_t generation_;
+
+    // The site's stats, looked up once and cached. The lookup is repeated
+    // if the vector is finished on another thread or the table was reset.
+    learning::SiteStats& Stats() {
+        learning::SiteTable* table = &learning::LocalSites();
+        std::uint64_t generation = learning::LocalGeneration();
+        if (stats_ == nullptr || table_ != table || generation_ != generation) {
+            stats_ = &learning::StatsOf(site_);
+            table_ = table;
+            generation_ = generation;
+        }
+        return *stats_;
+    }
+};
+
+} // namespace myvector
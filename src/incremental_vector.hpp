@@ -0,0 +1,490 @@
+#pragma once
+#include <memory>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+#include "forward.hpp"
+
+namespace myvector {
+
+// Vector with de-amortized growth. When it fills up, push_back allocates a
+// buffer of twice the capacity but does not relocate: the old buffer stays
+// alive and every later push_back moves at most migration_step() elements
+// across (one by default, which already finishes before the next growth,
+// and touches new pages as slowly as possible). Elements [migrated, old
+// size) are read from the old buffer until then, so no single operation
+// touches more than a bounded number of elements. That does not bound the
+// worst-case latency: the push_back that grows still calls allocate, and
+// the one that finishes a migration deallocates the old buffer, which for
+// large buffers costs time proportional to their size (unmapping them).
+// Element access never migrates, so references stay valid until
+// the next push_back, emplace_back, reserve or finish_migration, and data(),
+// begin() and end() (which finish the migration first to expose contiguous
+// storage).
+template<typename T, typename Allocator = std::allocator<T>>
+class IncrementalVector {
+    public:
+
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename std::allocator_traits<allocator_type>::pointer;
+    using const_pointer = typename std::allocator_traits<allocator_type>::const_pointer;
+
+    private:
+
+    // Iterates a const vector by index through Slot(), so it works without
+    // finishing a migration.
+    struct ConstIter {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const_pointer;
+        using reference = const_reference;
+
+        constexpr ConstIter() noexcept: vec_(nullptr), idx_(0) {}
+
+        constexpr ConstIter(const IncrementalVector* vec, size_type idx) noexcept: vec_(vec), idx_(idx) {}
+
+        constexpr ConstIter(const ConstIter& other) noexcept: vec_(other.vec_), idx_(other.idx_) {}
+
+        constexpr ConstIter& operator=(const ConstIter& other) noexcept {
+            vec_ = other.vec_;
+            idx_ = other.idx_;
+            return *this;
+        }
+
+        constexpr reference operator*() const noexcept {
+            return (*vec_)[idx_];
+        }
+
+        constexpr pointer operator->() const noexcept {
+            return vec_->Slot(idx_);
+        }
+
+        constexpr reference operator[](difference_type n) const noexcept {
+            return (*vec_)[idx_ + static_cast<size_type>(n)];
+        }
+
+        constexpr ConstIter& operator++() noexcept {
+            ++idx_;
+            return *this;
+        }
+
+        constexpr ConstIter operator++(int) noexcept {
+            return ConstIter(vec_, idx_++);
+        }
+
+        constexpr ConstIter& operator--() noexcept {
+            --idx_;
+            return *this;
+        }
+
+        constexpr ConstIter operator--(int) noexcept {
+            return ConstIter(vec_, idx_--);
+        }
+
+        constexpr ConstIter operator+(difference_type n) const noexcept {
+            return ConstIter(vec_, idx_ + static_cast<size_type>(n));
+        }
+
+        friend constexpr ConstIter operator+(difference_type n, const ConstIter& it) noexcept {
+            return it + n;
+        }
+
+        constexpr ConstIter operator-(difference_type n) const noexcept {
+            return ConstIter(vec_, idx_ - static_cast<size_type>(n));
+        }
+
+        constexpr ConstIter& operator+=(difference_type n) noexcept {
+            idx_ += static_cast<size_type>(n);
+            return *this;
+        }
+
+        constexpr ConstIter& operator-=(difference_type n) noexcept {
+            idx_ -= static_cast<size_type>(n);
+            return *this;
+        }
+
+        constexpr difference_type operator-(const ConstIter& other) const noexcept {
+            return static_cast<difference_type>(idx_ - other.idx_);
+        }
+
+        constexpr bool operator==(const ConstIter& other) const noexcept {
+            return idx_ == other.idx_;
+        }
+
+        constexpr auto operator<=>(const ConstIter& other) const noexcept {
+            return idx_ <=> other.idx_;
+        }
+
+        const IncrementalVector* vec_;
+        size_type idx_;
+    };
+
+    public:
+
+    using iterator = pointer;
+    using const_iterator = ConstIter;
+
+    constexpr IncrementalVector() noexcept(noexcept(allocator_type())):
+        allocator_(),
+        sz_(0),
+        cp_(0),
+        data_(nullptr),
+        old_data_(nullptr),
+        old_cp_(0),
+        old_sz_(0),
+        migrated_(0),
+        step_(kDefaultStep) {}
+
+    constexpr explicit IncrementalVector(const allocator_type& alloc) noexcept:
+        allocator_(alloc),
+        sz_(0),
+        cp_(0),
+        data_(nullptr),
+        old_data_(nullptr),
+        old_cp_(0),
+        old_sz_(0),
+        migrated_(0),
+        step_(kDefaultStep) {}
+
+    constexpr IncrementalVector(const IncrementalVector& other):
+        allocator_(std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.allocator_)),
+        sz_(0),
+        cp_(other.sz_),
+        data_(nullptr),
+        old_data_(nullptr),
+        old_cp_(0),
+        old_sz_(0),
+        migrated_(0),
+        step_(other.step_)
+        {
+            if (cp_ == 0) return;
+            data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
+            try {
+                for (; sz_ < other.sz_; ++sz_) {
+                    std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(data_ + sz_), other[sz_]);
+                }
+            }
+            catch (...) {
+                clear();
+                std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+                throw;
+            }
+        }
+
+    constexpr IncrementalVector(IncrementalVector&& other) noexcept:
+        allocator_(std::move(other.allocator_)),
+        sz_(other.sz_),
+        cp_(other.cp_),
+        data_(other.data_),
+        old_data_(other.old_data_),
+        old_cp_(other.old_cp_),
+        old_sz_(other.old_sz_),
+        migrated_(other.migrated_),
+        step_(other.step_)
+        {
+            other.sz_ = 0;
+            other.cp_ = 0;
+            other.data_ = nullptr;
+            other.old_data_ = nullptr;
+            other.old_cp_ = 0;
+            other.old_sz_ = 0;
+            other.migrated_ = 0;
+        }
+
+    ~IncrementalVector() {
+        clear();
+        if (data_ != nullptr) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+        }
+    }
+
+    constexpr IncrementalVector& operator=(const IncrementalVector& other) {
+        if (this == &other) return *this;
+        if (std::allocator_traits<allocator_type>::propagate_on_container_copy_assignment::value) {
+            if (allocator_ != other.allocator_) ReleaseStorage();
+            allocator_ = other.allocator_;
+        }
+        AssignElements(other, [](const_reference val) -> const_reference { return val; });
+        return *this;
+    }
+
+    constexpr IncrementalVector& operator=(IncrementalVector&& other)
+    noexcept(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+             std::allocator_traits<Allocator>::is_always_equal::value) {
+        if (this == &other) return *this;
+        if (std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+            allocator_ == other.allocator_) {
+            ReleaseStorage();
+            if (std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value) {
+                allocator_ = other.allocator_;
+            }
+            sz_ = other.sz_;
+            cp_ = other.cp_;
+            data_ = other.data_;
+            old_data_ = other.old_data_;
+            old_cp_ = other.old_cp_;
+            old_sz_ = other.old_sz_;
+            migrated_ = other.migrated_;
+            step_ = other.step_;
+            other.sz_ = 0;
+            other.cp_ = 0;
+            other.data_ = nullptr;
+            other.old_data_ = nullptr;
+            other.old_cp_ = 0;
+            other.old_sz_ = 0;
+            other.migrated_ = 0;
+        }
+        else {
+            AssignElements(other, [](reference val) -> T&& { return std::move(val); });
+        }
+        return *this;
+    }
+
+    constexpr allocator_type get_allocator() const noexcept {
+        return allocator_;
+    }
+
+    constexpr reference at(size_type pos) {
+        if (pos >= sz_) throw std::out_of_range("IncrementalVector::at");
+        return (*this)[pos];
+    }
+
+    constexpr const_reference at(size_type pos) const {
+        if (pos >= sz_) throw std::out_of_range("IncrementalVector::at");
+        return (*this)[pos];
+    }
+
+    constexpr reference operator[](size_type pos) noexcept {
+        return *Slot(pos);
+    }
+
+    constexpr const_reference operator[](size_type pos) const noexcept {
+        return *Slot(pos);
+    }
+
+    constexpr reference front() noexcept {
+        return *Slot(0);
+    }
+
+    constexpr const_reference front() const noexcept {
+        return *Slot(0);
+    }
+
+    constexpr reference back() noexcept {
+        return *Slot(sz_ - 1);
+    }
+
+    constexpr const_reference back() const noexcept {
+        return *Slot(sz_ - 1);
+    }
+
+    constexpr pointer data() {
+        finish_migration();
+        return data_;
+    }
+
+    constexpr iterator begin() {
+        finish_migration();
+        return data_;
+    }
+
+    constexpr iterator end() {
+        finish_migration();
+        return data_ + sz_;
+    }
+
+    // Const access cannot finish a migration, so there is no const data()
+    // and const iterators read each element through its current slot.
+    constexpr const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return cend();
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return const_iterator(this, sz_);
+    }
+
+    constexpr bool empty() const noexcept {
+        return sz_ == 0;
+    }
+
+    constexpr size_type size() const noexcept {
+        return sz_;
+    }
+
+    constexpr size_type max_size() const noexcept {
+        return std::allocator_traits<allocator_type>::max_size(allocator_);
+    }
+
+    constexpr size_type capacity() const noexcept {
+        return cp_;
+    }
+
+    constexpr bool migrating() const noexcept {
+        return old_data_ != nullptr;
+    }
+
+    constexpr size_type migration_step() const noexcept {
+        return step_;
+    }
+
+    constexpr void set_migration_step(size_type step) noexcept {
+        step_ = step == 0 ? 1 : step;
+    }
+
+    constexpr void finish_migration() {
+        if (migrating()) Migrate(old_sz_);
+    }
+
+    // Explicit reservations relocate everything at once, like Vector::reserve.
+    constexpr void reserve(size_type new_cap) {
+        if (new_cap <= cp_) return;
+        if (new_cap >= max_size()) throw std::length_error("IncrementalVector::reserve");
+        finish_migration();
+        StartMigration(new_cap);
+        finish_migration();
+    }
+
+    constexpr void clear() noexcept {
+        for (size_type idx = 0; idx < sz_; ++idx) {
+            std::allocator_traits<allocator_type>::destroy(allocator_, std::to_address(Slot(idx)));
+        }
+        sz_ = 0;
+        ReleaseOld();
+    }
+
+    constexpr void push_back(const_reference val) {
+        emplace_back(val);
+    }
+
+    constexpr void push_back(T&& val) {
+        emplace_back(std::move(val));
+    }
+
+    template<typename... Args>
+    constexpr reference emplace_back(Args&&... args) {
+        if (sz_ == cp_) {
+            finish_migration();
+            StartMigration(cp_ == 0 ? 2 : cp_ * 2);
+        }
+        pointer slot = data_ + sz_;
+        std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(slot), myforward::forward<Args>(args)...);
+        ++sz_;
+        if (migrating()) Migrate(step_);
+        return *slot;
+    }
+
+    constexpr void pop_back() noexcept {
+        --sz_;
+        std::allocator_traits<allocator_type>::destroy(allocator_, std::to_address(Slot(sz_)));
+        if (sz_ < old_sz_) {
+            old_sz_ = sz_;
+            if (migrated_ >= old_sz_) ReleaseOld();
+        }
+    }
+
+    constexpr void swap(IncrementalVector& other)
+    noexcept(std::allocator_traits<Allocator>::propagate_on_container_swap::value ||
+             std::allocator_traits<Allocator>::is_always_equal::value) {
+        if (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+            std::swap(allocator_, other.allocator_);
+        }
+        std::swap(sz_, other.sz_);
+        std::swap(cp_, other.cp_);
+        std::swap(data_, other.data_);
+        std::swap(old_data_, other.old_data_);
+        std::swap(old_cp_, other.old_cp_);
+        std::swap(old_sz_, other.old_sz_);
+        std::swap(migrated_, other.migrated_);
+        std::swap(step_, other.step_);
+    }
+
+    private:
+
+    static constexpr size_type kDefaultStep = 1;
+
+    allocator_type allocator_;
+    size_type sz_;
+    size_type cp_;
+    pointer data_;
+    pointer old_data_;
+    size_type old_cp_;
+    size_type old_sz_;
+    size_type migrated_;
+    size_type step_;
+
+    constexpr void ReleaseStorage() noexcept {
+        clear();
+        if (data_ != nullptr) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+        }
+        data_ = nullptr;
+        cp_ = 0;
+    }
+
+    // Replaces the contents element by element with get(other[idx]), keeping
+    // this vector's buffer and allocator, then takes over other's step.
+    template<typename Source, typename Get>
+    constexpr void AssignElements(Source& other, Get get) {
+        clear();
+        reserve(other.sz_);
+        for (size_type idx = 0; idx < other.sz_; ++idx) {
+            emplace_back(get(other[idx]));
+        }
+        step_ = other.step_;
+    }
+
+    // Elements [migrated_, old_sz_) still live in the old buffer. Outside a
+    // migration both are 0, so the range check alone decides.
+    constexpr pointer Slot(size_type pos) const noexcept {
+        return pos - migrated_ < old_sz_ - migrated_ ? old_data_ + pos : data_ + pos;
+    }
+
+    constexpr void StartMigration(size_type new_cap) {
+        pointer new_data = std::allocator_traits<allocator_type>::allocate(allocator_, new_cap);
+        old_data_ = data_;
+        old_cp_ = cp_;
+        old_sz_ = sz_;
+        migrated_ = 0;
+        data_ = new_data;
+        cp_ = new_cap;
+        if (old_sz_ == 0) ReleaseOld();
+    }
+
+    constexpr void Migrate(size_type count) {
+        for (; count > 0 && migrated_ < old_sz_; --count) {
+            std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(data_ + migrated_),
+                                                             std::move_if_noexcept(old_data_[migrated_]));
+            std::allocator_traits<allocator_type>::destroy(allocator_, std::to_address(old_data_ + migrated_));
+            ++migrated_;
+        }
+        if (migrated_ >= old_sz_) ReleaseOld();
+    }
+
+    // Only called once no constructed element is left in the old buffer.
+    constexpr void ReleaseOld() noexcept {
+        if (old_data_ != nullptr) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, old_data_, old_cp_);
+        }
+        old_data_ = nullptr;
+        old_cp_ = 0;
+        old_sz_ = 0;
+        migrated_ = 0;
+    }
+};
+
+} // namespace myvector
@@ -1,4 +1,9 @@
 #include "vector.hpp"
+#include "recycling_allocator.hpp"
+#include "mmap_allocator.hpp"
+#include "ring_vector.hpp"
+#include "incremental_vector.hpp"
+#include "capacity_learning.hpp"
 #include <memory>
 #include <vector>
 #include <iostream>
@@ -6,6 +11,8 @@
 #include <algorithm>
 #include <cmath>
 #include <random>
+#include <string>
+#include <sstream>
 
 
 using myvector::Vector;
@@ -115,6 +122,344 @@ void TestReverseSort() {
     std::cout << '\n';
 }
 
+void TestRecycling() {
+    std::cout << "\nTestRecycling:\n";
+    myvector::trim_recycling_cache();
+    myvector::reset_recycling_stats();
+    for (int round = 0; round < 4; ++round) {
+        Vector<int, myvector::RecyclingAllocator<int>> vec;
+        for (int idx = 0; idx < 100; ++idx) {
+            vec.push_back(idx);
+        }
+    }
+    myvector::RecyclingStats stats = myvector::recycling_stats();
+    std::cout << "hits: " << stats.thread_hits << "\tmisses: " << stats.misses
+              << "\tretained: " << stats.retained_bytes << '\n';
+    std::cout << "trimmed: " << myvector::trim_recycling_cache() << '\n';
+}
+
+void TestShrinkPolicy() {
+    std::cout << "\nTestShrinkPolicy:\n";
+    Vector<int> vec;
+    vec.set_shrink_policy({0.25f, 0.5f});
+    Fill(vec, 1000);
+    std::cout << "size: " << vec.size() << "\tcapacity: " << vec.capacity() << '\n';
+    while (vec.size() > 100) vec.pop_back();
+    std::cout << "size: " << vec.size() << "\tcapacity: " << vec.capacity() << '\n';
+    vec.erase(vec.begin());
+    vec.resize(30);
+    std::cout << "size: " << vec.size() << "\tcapacity: " << vec.capacity() << '\n';
+    vec.clear();
+    std::cout << "size: " << vec.size() << "\tcapacity: " << vec.capacity() << '\n';
+
+    Vector<int> moved(std::move(vec));
+    Vector<int> swapped;
+    swapped.swap(moved);
+    vec.swap(swapped);
+    std::cout << "thresholds: " << vec.shrink_policy().threshold << ' ' << moved.shrink_policy().threshold
+              << ' ' << swapped.shrink_policy().threshold << '\n';
+
+    Vector<int, myvector::MmapAllocator<int>> mapped(100000);
+    int* old_data = mapped.data();
+    mapped.resize(10);
+    bool shrunk = mapped.shrink_to_fit_in_place();
+    std::cout << "in place: " << shrunk << "\tsame buffer: " << (mapped.data() == old_data)
+              << "\tcapacity: " << mapped.capacity() << '\n';
+
+    try {
+        vec.set_shrink_policy({std::nanf(""), 0.5f});
+    }
+    catch (const std::invalid_argument& err) {
+        std::cout << "caught: " << err.what() << '\n';
+    }
+    try {
+        vec.set_shrink_policy({0.25f, std::nanf("")});
+    }
+    catch (const std::invalid_argument& err) {
+        std::cout << "caught: " << err.what() << '\n';
+    }
+}
+
+void TestExpressions() {
+    std::cout << "\nTestExpressions:\n";
+    const size_t size = 100000;
+    Vector<double> b(size), c(size), d(size);
+    for (size_t idx = 0; idx < size; ++idx) {
+        b[idx] = std::rand() % 1000 / 10.0;
+        c[idx] = std::rand() % 1000 / 10.0;
+        d[idx] = std::rand() % 1000 / 10.0 - 50;
+    }
+
+    Vector<double> a = b * c + d * 2.0;
+    Vector<double> e;
+    e.assign_parallel(sqrt(b) - abs(d) / (c + 1.0), 4);
+    Vector<double> g(size / 2);
+    g.reserve(size);
+    g.assign_parallel(b - c, 4);
+
+    auto differs = [](double x, double y) { return x < y || x > y; };
+    size_t mismatches = 0;
+    for (size_t idx = 0; idx < size; ++idx) {
+        if (differs(a[idx], b[idx] * c[idx] + d[idx] * 2.0)) ++mismatches;
+        if (differs(e[idx], std::sqrt(b[idx]) - std::abs(d[idx]) / (c[idx] + 1.0))) ++mismatches;
+        if (differs(g[idx], b[idx] - c[idx])) ++mismatches;
+    }
+    a = -a + 1.0;
+    if (differs(a[0], 1.0 - (b[0] * c[0] + d[0] * 2.0))) ++mismatches;
+    std::cout << "mismatches: " << mismatches << '\n';
+
+    try {
+        Vector<double> f = b + Vector<double>(3);
+    }
+    catch (const std::length_error& err) {
+        std::cout << "caught: " << err.what() << '\n';
+    }
+}
+
+void TestRingVector() {
+    std::cout << "\nTestRingVector:\n";
+    myvector::RingVector<int> ring;
+    for (int idx = 0; idx < 6; ++idx) {
+        ring.push_back(idx);
+    }
+    ring.pop_front();
+    ring.pop_front();
+    ring.push_front(-1);
+    ring.push_back(6);
+    ring.push_back(7);
+    std::for_each(ring.begin(), ring.end(), Print);
+    std::cout << "\ncapacity: " << ring.capacity() << "\tfront: " << ring.front() << "\tback: " << ring.back() << '\n';
+
+    std::span<int> view = ring.linearize();
+    std::sort(view.begin(), view.end(), [](int x, int y) { return x > y; });
+    std::for_each(view.begin(), view.end(), Print);
+    std::cout << '\n';
+
+    myvector::RingVector<int> telemetry;
+    telemetry.set_bound(4);
+    for (int idx = 0; idx < 10; ++idx) {
+        telemetry.push_back(idx);
+    }
+    std::for_each(telemetry.begin(), telemetry.end(), Print);
+    std::cout << "\ncapacity: " << telemetry.capacity() << '\n';
+    view = telemetry.linearize();
+    std::for_each(view.begin(), view.end(), Print);
+    std::cout << '\n';
+
+    myvector::RingVector<int> moved(std::move(telemetry));
+    telemetry.push_back(1);
+    telemetry.push_back(2);
+    std::cout << "moved-from: " << telemetry.size() << '/' << telemetry.bound()
+              << "\tmoved: " << moved.size() << '/' << moved.bound() << '\n';
+    telemetry = std::move(moved);
+    moved.push_front(3);
+    std::cout << "moved-from: " << moved.size() << '/' << moved.bound()
+              << "\tassigned: " << telemetry.size() << '/' << telemetry.bound() << '\n';
+    myvector::RingVector<std::string> queue;
+    for (int idx = 0; idx < 4; ++idx) {
+        queue.push_back(std::string(32, char('a' + idx)));
+    }
+    queue.push_back(queue.front());
+    for (int idx = 4; idx < 7; ++idx) {
+        queue.push_back(std::string(32, char('a' + idx)));
+    }
+    queue.push_front(queue.back());
+    std::cout << "rotated: " << queue.size() << ' ' << queue.front().substr(0, 3) << ' '
+              << queue[5].substr(0, 3) << ' ' << queue.back().substr(0, 3) << '\n';
+    myvector::RingVector<int> copy;
+    copy = telemetry;
+    copy.push_back(10);
+    std::for_each(copy.begin(), copy.end(), Print);
+    std::cout << '\n';
+}
+
+int Sum(myvector::VectorView<const int> view) {
+    int sum = 0;
+    for (int x : view) sum += x;
+    return sum;
+}
+
+struct Tracked {
+    static inline int live = 0;
+
+    Tracked() { ++live; }
+    Tracked(const Tracked&) { ++live; }
+    Tracked& operator=(const Tracked&) = default;
+    ~Tracked() { --live; }
+};
+
+void TestAdoptRelease() {
+    std::cout << "\nTestAdoptRelease:\n";
+    std::allocator<int> alloc;
+    int* buffer = alloc.allocate(16);
+    for (int idx = 0; idx < 10; ++idx) {
+        buffer[idx] = idx;
+    }
+
+    Vector<int> vec;
+    vec.adopt(buffer, 10, 16, alloc);
+    vec.push_back(10);
+    std::cout << "same buffer: " << (vec.data() == buffer) << "\tsize: " << vec.size()
+              << "\tcapacity: " << vec.capacity() << "\tsum: " << Sum(vec) << '\n';
+
+    Vector<int>::buffer_type released = vec.release();
+    std::cout << "released: " << released.size << '/' << released.capacity
+              << "\tsame buffer: " << (released.data == buffer) << "\tvec size: " << vec.size() << '\n';
+    alloc.deallocate(released.data, released.capacity);
+
+    {
+        Vector<Tracked> items;
+        for (int idx = 0; idx < 6; ++idx) {
+            items.push_back(Tracked());
+        }
+        Tracked* own = items.data();
+        items.adopt(own, 2, items.capacity(), items.get_allocator());
+        std::cout << "self-adopt: " << items.size() << '/' << items.capacity()
+                  << "\tsame buffer: " << (items.data() == own) << "\tlive: " << Tracked::live << '\n';
+    }
+    std::cout << "live after destruction: " << Tracked::live << '\n';
+
+    try {
+        Vector<int> small(6);
+        small.adopt(small.data(), 2, 64, small.get_allocator());
+    }
+    catch (const std::invalid_argument& err) {
+        std::cout << "caught: " << err.what() << '\n';
+    }
+
+    try {
+        int* bad = alloc.allocate(4);
+        try {
+            vec.adopt(bad, 8, 4, alloc);
+        }
+        catch (...) {
+            alloc.deallocate(bad, 4);
+            throw;
+        }
+    }
+    catch (const std::invalid_argument& err) {
+        std::cout << "caught: " << err.what() << '\n';
+    }
+}
+
+// Stateful allocator that never propagates, so assignments between
+// containers with different ids must copy or move element by element.
+template<typename T>
+struct TaggedAllocator: std::allocator<T> {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    template<typename U>
+    struct rebind {
+        using other = TaggedAllocator<U>;
+    };
+
+    explicit TaggedAllocator(int tag): std::allocator<T>(), id(tag) {}
+
+    template<typename U>
+    TaggedAllocator(const TaggedAllocator<U>& other): std::allocator<T>(), id(other.id) {}
+
+    bool operator==(const TaggedAllocator& other) const noexcept {
+        return id == other.id;
+    }
+
+    int id;
+};
+
+void TestIncremental() {
+    std::cout << "\nTestIncremental:\n";
+    myvector::IncrementalVector<int> vec;
+    vec.set_migration_step(2);
+    for (int idx = 0; idx < 9; ++idx) {
+        vec.push_back(idx);
+    }
+    std::cout << "capacity: " << vec.capacity() << "\tmigrating: " << vec.migrating() << '\n';
+    const myvector::IncrementalVector<int>& cvec = vec;
+    std::for_each(cvec.begin(), cvec.end(), Print);
+    std::cout << "\nsorted: " << std::is_sorted(cvec.begin(), cvec.end()) << "\tmigrating: " << vec.migrating();
+    vec.pop_back();
+    vec.push_back(-1);
+    std::cout << "\nmigrating: " << vec.migrating() << '\n';
+    std::for_each(vec.begin(), vec.end(), Print);
+    std::cout << "\nmigrating: " << vec.migrating() << '\n';
+
+    myvector::IncrementalVector<std::string> strings;
+    for (int idx = 0; idx < 20; ++idx) {
+        strings.push_back(std::to_string(idx));
+    }
+    myvector::IncrementalVector<std::string> copy(strings);
+    strings.clear();
+    std::cout << copy.size() << ' ' << copy.front() << ' ' << copy.back() << '\n';
+
+    myvector::IncrementalVector<std::string> names;
+    for (int idx = 0; idx < 33; ++idx) {
+        names.push_back(std::string(32, char('a' + idx % 26)));
+    }
+    std::string& kept = names[20];
+    names[0].swap(names[1]);
+    std::swap(names[2], names[30]);
+    names.front() += '!';
+    std::cout << "migrating: " << names.migrating() << '\t' << kept.substr(0, 3) << ' '
+              << names[0].substr(0, 3) << ' ' << names[2].substr(0, 3) << ' ' << names[1].size() << '\n';
+
+    using Tagged = myvector::IncrementalVector<std::string, TaggedAllocator<std::string>>;
+    Tagged first(TaggedAllocator<std::string>(1)), second(TaggedAllocator<std::string>(2));
+    for (int idx = 0; idx < 5; ++idx) {
+        first.push_back(std::string(32, char('a' + idx)));
+    }
+    second = first;
+    second.push_back(std::string(32, 'z'));
+    first = std::move(second);
+    std::cout << "tagged: " << first.size() << ' ' << first.back().substr(0, 3) << " allocator "
+              << first.get_allocator().id << "\tswap noexcept: " << noexcept(first.swap(second)) << '\n';
+}
+
+size_t BuildLearned(int count) {
+    myvector::LearnedVector<int> vec;
+    size_t initial = vec.capacity();
+    for (int idx = 0; idx < count; ++idx) {
+        vec.push_back(idx);
+    }
+    return initial;
+}
+
+void TestCapacityLearning() {
+    std::cout << "\nTestCapacityLearning:\n";
+    myvector::set_capacity_learning({0.9, 4});
+    for (int round = 0; round < 6; ++round) {
+        std::cout << BuildLearned(100 + round) << '\t';
+    }
+    std::cout << '\n';
+
+    std::stringstream profile;
+    myvector::dump_capacity_profile(profile);
+    myvector::reset_capacity_learning();
+    std::cout << "after reset: " << BuildLearned(100) << '\n';
+
+    myvector::reset_capacity_learning();
+    std::cout << "loaded: " << myvector::load_capacity_profile(profile) << '\n';
+    std::cout << "after load: " << BuildLearned(100) << '\n';
+
+    myvector::LearnedVector<int> hinted;
+    hinted.resize(10);
+    hinted.record_size();
+    std::cout << "hinted: " << hinted.size() << '\n';
+
+    myvector::reset_capacity_learning();
+    for (int round = 0; round < 5; ++round) {
+        std::cout << BuildLearned(64) << '\t';
+    }
+    std::cout << '\n';
+
+    std::stringstream bad("neg.cpp:1:1 -5\nsuffix.cpp:1:1 123abc\nempty.cpp:1:1 \n"
+                          "huge.cpp:1:1 18446744073709551615\nok.cpp:1:1 64\n");
+    std::cout << "loaded bad: " << myvector::load_capacity_profile(bad) << '\n';
+    myvector::set_capacity_learning({});
+}
+
 int main() {
     TestForEach();
     TestSort();
@@ -123,6 +468,13 @@ int main() {
     TestForAuto();
     TestInitList();
     TestReverseSort();
+    TestRecycling();
+    TestShrinkPolicy();
+    TestExpressions();
+    TestRingVector();
+    TestAdoptRelease();
+    TestIncremental();
+    TestCapacityLearning();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace myvector {
+
+// Allocates every buffer as its own anonymous mapping, so unused tail pages
+// can be handed back to the system with shrink_in_place instead of moving
+// the elements (see Vector::shrink_to_fit_in_place).
+template<typename T>
+class MmapAllocator {
+    public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    constexpr MmapAllocator() noexcept = default;
+
+    template<typename U>
+    constexpr MmapAllocator(const MmapAllocator<U>&) noexcept {}
+
+    T* allocate(size_type n) {
+        if (n > static_cast<size_type>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        void* ptr = mmap(nullptr, MappedBytes(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) throw std::bad_alloc();
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_type n) noexcept {
+        munmap(ptr, MappedBytes(n));
+    }
+
+    size_type shrink_in_place(T* ptr, size_type n, size_type new_n) noexcept {
+        size_type old_bytes = MappedBytes(n);
+        size_type kept = MappedBytes(new_n) / sizeof(T);
+        size_type kept_bytes = MappedBytes(kept);
+        if (kept_bytes >= old_bytes) return n;
+
+        if (munmap(reinterpret_cast<char*>(ptr) + kept_bytes, old_bytes - kept_bytes) != 0) return n;
+        return kept;
+    }
+
+    template<typename U>
+    constexpr bool operator==(const MmapAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    private:
+
+    static size_type PageSize() noexcept {
+        static const size_type page = static_cast<size_type>(sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+    static size_type MappedBytes(size_type n) noexcept {
+        size_type page = PageSize();
+        size_type bytes = n * sizeof(T);
+        if (bytes == 0) return page;
+        return (bytes + page - 1) / page * page;
+    }
+};
+
+} // namespace myvector
@@ -0,0 +1,294 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <bit>
+#include <type_traits>
+
+namespace myvector {
+
+// Freed buffers are kept in intrusive free lists, bucketed by power-of-two
+// byte classes. Each thread owns a cache; what does not fit there overflows
+// into a bounded global pool shared by all threads.
+
+struct RecyclingLimits {
+    std::size_t thread_bytes = std::size_t(4) << 20;
+    std::size_t global_bytes = std::size_t(64) << 20;
+};
+
+struct RecyclingStats {
+    std::size_t thread_hits = 0;
+    std::size_t global_hits = 0;
+    std::size_t misses = 0;
+    std::size_t released = 0;
+    std::size_t retained_bytes = 0;
+};
+
+namespace recycling {
+
+constexpr std::size_t kMinBlock = 16;
+constexpr std::size_t kClassCount = 40;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+inline std::atomic<std::size_t> thread_limit{RecyclingLimits().thread_bytes};
+inline std::atomic<std::size_t> global_limit{RecyclingLimits().global_bytes};
+
+constexpr std::size_t ClassOf(std::size_t bytes) noexcept {
+    if (bytes <= kMinBlock) return 0;
+    std::size_t cls = std::bit_width(bytes - 1) - std::bit_width(kMinBlock - 1);
+    return cls < kClassCount ? cls : kClassCount;
+}
+
+constexpr std::size_t ClassBytes(std::size_t cls) noexcept {
+    return kMinBlock << cls;
+}
+
+class GlobalPool {
+    public:
+
+    GlobalPool() noexcept: mutex_(), heads_(), retained_(0) {}
+
+    GlobalPool(const GlobalPool&) = delete;
+    GlobalPool& operator=(const GlobalPool&) = delete;
+
+    ~GlobalPool() {
+        Trim(0);
+    }
+
+    FreeBlock* Pop(std::size_t cls) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FreeBlock* block = heads_[cls];
+        if (block != nullptr) {
+            heads_[cls] = block->next;
+            retained_ -= ClassBytes(cls);
+        }
+        return block;
+    }
+
+    bool Push(std::size_t cls, FreeBlock* block) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (retained_ + ClassBytes(cls) > global_limit.load(std::memory_order_relaxed)) return false;
+        block->next = heads_[cls];
+        heads_[cls] = block;
+        retained_ += ClassBytes(cls);
+        return true;
+    }
+
+    std::size_t Trim(std::size_t keep_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t released = 0;
+        for (std::size_t cls = kClassCount; cls-- > 0 && retained_ > keep_bytes;) {
+            while (heads_[cls] != nullptr && retained_ > keep_bytes) {
+                FreeBlock* block = heads_[cls];
+                heads_[cls] = block->next;
+                retained_ -= ClassBytes(cls);
+                ::operator delete(block);
+                ++released;
+            }
+        }
+        return released;
+    }
+
+    std::size_t Retained() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return retained_;
+    }
+
+    private:
+
+    std::mutex mutex_;
+    FreeBlock* heads_[kClassCount];
+    std::size_t retained_;
+};
+
+inline GlobalPool& Global() {
+    static GlobalPool pool;
+    return pool;
+}
+
+class ThreadCache {
+    public:
+
+    ThreadCache(): heads_(), retained_(0), stats_() {
+        Global();
+    }
+
+    ThreadCache(const ThreadCache&) = delete;
+    ThreadCache& operator=(const ThreadCache&) = delete;
+
+    ~ThreadCache() {
+        for (std::size_t cls = 0; cls < kClassCount; ++cls) {
+            while (heads_[cls] != nullptr) {
+                FreeBlock* block = heads_[cls];
+                heads_[cls] = block->next;
+                bool pooled = false;
+                try {
+                    pooled = Global().Push(cls, block);
+                }
+                catch (...) {}
+                if (!pooled) ::operator delete(block);
+            }
+        }
+    }
+
+    void* Allocate(std::size_t bytes) {
+        std::size_t cls = ClassOf(bytes);
+        if (cls == kClassCount) {
+            ++stats_.misses;
+            return ::operator new(bytes);
+        }
+
+        FreeBlock* block = heads_[cls];
+        if (block != nullptr) {
+            heads_[cls] = block->next;
+            retained_ -= ClassBytes(cls);
+            ++stats_.thread_hits;
+            return block;
+        }
+
+        block = Global().Pop(cls);
+        if (block != nullptr) {
+            ++stats_.global_hits;
+            return block;
+        }
+
+        ++stats_.misses;
+        return ::operator new(ClassBytes(cls));
+    }
+
+    void Deallocate(void* ptr, std::size_t bytes) noexcept {
+        std::size_t cls = ClassOf(bytes);
+        if (cls == kClassCount) {
+            ++stats_.released;
+            ::operator delete(ptr);
+            return;
+        }
+
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        if (retained_ + ClassBytes(cls) <= thread_limit.load(std::memory_order_relaxed)) {
+            block->next = heads_[cls];
+            heads_[cls] = block;
+            retained_ += ClassBytes(cls);
+            return;
+        }
+
+        bool pooled = false;
+        try {
+            pooled = Global().Push(cls, block);
+        }
+        catch (...) {}
+        if (!pooled) {
+            ++stats_.released;
+            ::operator delete(ptr);
+        }
+    }
+
+    std::size_t Trim(std::size_t keep_bytes) noexcept {
+        std::size_t released = 0;
+        for (std::size_t cls = kClassCount; cls-- > 0 && retained_ > keep_bytes;) {
+            while (heads_[cls] != nullptr && retained_ > keep_bytes) {
+                FreeBlock* block = heads_[cls];
+                heads_[cls] = block->next;
+                retained_ -= ClassBytes(cls);
+                ::operator delete(block);
+                ++released;
+            }
+        }
+        stats_.released += released;
+        return released;
+    }
+
+    RecyclingStats Stats() const noexcept {
+        RecyclingStats stats = stats_;
+        stats.retained_bytes = retained_;
+        return stats;
+    }
+
+    void ResetStats() noexcept {
+        stats_ = RecyclingStats();
+    }
+
+    private:
+
+    FreeBlock* heads_[kClassCount];
+    std::size_t retained_;
+    RecyclingStats stats_;
+};
+
+inline ThreadCache& Local() {
+    thread_local ThreadCache cache;
+    return cache;
+}
+
+} // namespace recycling
+
+inline void set_recycling_limits(const RecyclingLimits& limits) noexcept {
+    recycling::thread_limit.store(limits.thread_bytes, std::memory_order_relaxed);
+    recycling::global_limit.store(limits.global_bytes, std::memory_order_relaxed);
+}
+
+inline RecyclingLimits recycling_limits() noexcept {
+    RecyclingLimits limits;
+    limits.thread_bytes = recycling::thread_limit.load(std::memory_order_relaxed);
+    limits.global_bytes = recycling::global_limit.load(std::memory_order_relaxed);
+    return limits;
+}
+
+// Statistics of the calling thread's cache. retained_bytes covers this thread only.
+inline RecyclingStats recycling_stats() noexcept {
+    return recycling::Local().Stats();
+}
+
+inline void reset_recycling_stats() noexcept {
+    recycling::Local().ResetStats();
+}
+
+// Returns cached buffers to the system until the calling thread's cache holds
+// at most keep_bytes, then does the same for the global pool.
+// Returns the number of buffers released.
+inline std::size_t trim_recycling_cache(std::size_t keep_bytes = 0) {
+    return recycling::Local().Trim(keep_bytes) + recycling::Global().Trim(keep_bytes);
+}
+
+inline std::size_t global_recycling_retained() {
+    return recycling::Global().Retained();
+}
+
+template<typename T>
+class RecyclingAllocator {
+    public:
+
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "RecyclingAllocator: over-aligned types are not supported");
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    constexpr RecyclingAllocator() noexcept = default;
+
+    template<typename U>
+    constexpr RecyclingAllocator(const RecyclingAllocator<U>&) noexcept {}
+
+    T* allocate(size_type n) {
+        if (n > static_cast<size_type>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(recycling::Local().Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_type n) noexcept {
+        recycling::Local().Deallocate(ptr, n * sizeof(T));
+    }
+
+    template<typename U>
+    constexpr bool operator==(const RecyclingAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+} // namespace myvector
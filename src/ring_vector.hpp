@@ -0,0 +1,551 @@
+#pragma once
+#include <memory>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <span>
+#include "forward.hpp"
+
+namespace myvector {
+
+// Double-ended queue over a single circular buffer. Uses the same allocator
+// and doubling growth as Vector, but push/pop at both ends are amortized O(1).
+// With set_bound(n) the capacity is fixed to n and pushing into a full ring
+// overwrites the element at the opposite end.
+template<typename T, typename Allocator = std::allocator<T>>
+class RingVector {
+    public:
+
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename std::allocator_traits<allocator_type>::pointer;
+    using const_pointer = typename std::allocator_traits<allocator_type>::const_pointer;
+
+    private:
+
+    template<bool Const>
+    struct RingIter {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const_pointer, typename RingVector::pointer>;
+        using reference = std::conditional_t<Const, const_reference, typename RingVector::reference>;
+        using ring_t = std::conditional_t<Const, const RingVector, RingVector>;
+
+        constexpr RingIter() noexcept: ring_(nullptr), idx_(0) {}
+
+        constexpr RingIter(ring_t* ring, size_type idx) noexcept: ring_(ring), idx_(idx) {}
+
+        constexpr RingIter(const RingIter& other) noexcept: ring_(other.ring_), idx_(other.idx_) {}
+
+        constexpr RingIter(const RingIter<false>& other) noexcept requires Const: ring_(other.ring_), idx_(other.idx_) {}
+
+        constexpr RingIter& operator=(const RingIter& other) noexcept {
+            ring_ = other.ring_;
+            idx_ = other.idx_;
+            return *this;
+        }
+
+        constexpr reference operator*() const noexcept {
+            return (*ring_)[idx_];
+        }
+
+        constexpr pointer operator->() const noexcept {
+            return std::addressof((*ring_)[idx_]);
+        }
+
+        constexpr reference operator[](difference_type n) const noexcept {
+            return (*ring_)[idx_ + static_cast<size_type>(n)];
+        }
+
+        constexpr RingIter& operator++() noexcept {
+            ++idx_;
+            return *this;
+        }
+
+        constexpr RingIter operator++(int) noexcept {
+            return RingIter(ring_, idx_++);
+        }
+
+        constexpr RingIter& operator--() noexcept {
+            --idx_;
+            return *this;
+        }
+
+        constexpr RingIter operator--(int) noexcept {
+            return RingIter(ring_, idx_--);
+        }
+
+        constexpr RingIter operator+(difference_type n) const noexcept {
+            return RingIter(ring_, idx_ + static_cast<size_type>(n));
+        }
+
+        friend constexpr RingIter operator+(difference_type n, const RingIter& it) noexcept {
+            return it + n;
+        }
+
+        constexpr RingIter operator-(difference_type n) const noexcept {
+            return RingIter(ring_, idx_ - static_cast<size_type>(n));
+        }
+
+        constexpr RingIter& operator+=(difference_type n) noexcept {
+            idx_ += static_cast<size_type>(n);
+            return *this;
+        }
+
+        constexpr RingIter& operator-=(difference_type n) noexcept {
+            idx_ -= static_cast<size_type>(n);
+            return *this;
+        }
+
+        constexpr difference_type operator-(const RingIter& other) const noexcept {
+            return static_cast<difference_type>(idx_ - other.idx_);
+        }
+
+        constexpr bool operator==(const RingIter& other) const noexcept {
+            return idx_ == other.idx_;
+        }
+
+        constexpr auto operator<=>(const RingIter& other) const noexcept {
+            return idx_ <=> other.idx_;
+        }
+
+        ring_t* ring_;
+        size_type idx_;
+    };
+
+    public:
+
+    using iterator = RingIter<false>;
+    using const_iterator = RingIter<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    constexpr RingVector() noexcept(noexcept(allocator_type())):
+        allocator_(),
+        sz_(0),
+        cp_(0),
+        head_(0),
+        bound_(0),
+        data_(nullptr) {}
+
+    constexpr explicit RingVector(const allocator_type& alloc) noexcept:
+        allocator_(alloc),
+        sz_(0),
+        cp_(0),
+        head_(0),
+        bound_(0),
+        data_(nullptr) {}
+
+    constexpr RingVector(const RingVector& other):
+        allocator_(std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.allocator_)),
+        sz_(0),
+        cp_(other.cp_),
+        head_(0),
+        bound_(other.bound_),
+        data_(nullptr)
+        {
+            if (cp_ == 0) return;
+            data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
+            try {
+                for (; sz_ < other.sz_; ++sz_) {
+                    std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(data_ + sz_), other[sz_]);
+                }
+            }
+            catch (...) {
+                clear();
+                std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+                throw;
+            }
+        }
+
+    constexpr RingVector(RingVector&& other) noexcept:
+        allocator_(std::move(other.allocator_)),
+        sz_(other.sz_),
+        cp_(other.cp_),
+        head_(other.head_),
+        bound_(other.bound_),
+        data_(other.data_)
+        {
+            other.sz_ = 0;
+            other.cp_ = 0;
+            other.head_ = 0;
+            other.bound_ = 0;
+            other.data_ = nullptr;
+        }
+
+    ~RingVector() {
+        clear();
+        if (data_ != nullptr) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+        }
+    }
+
+    constexpr RingVector& operator=(const RingVector& other) {
+        if (this == &other) return *this;
+        if (std::allocator_traits<allocator_type>::propagate_on_container_copy_assignment::value) {
+            if (allocator_ != other.allocator_) ReleaseStorage();
+            allocator_ = other.allocator_;
+        }
+        AssignElements(other, [](const_reference val) -> const_reference { return val; });
+        return *this;
+    }
+
+    constexpr RingVector& operator=(RingVector&& other)
+    noexcept(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+             std::allocator_traits<Allocator>::is_always_equal::value) {
+        if (this == &other) return *this;
+        if (std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+            allocator_ == other.allocator_) {
+            ReleaseStorage();
+            if (std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value) {
+                allocator_ = other.allocator_;
+            }
+            sz_ = other.sz_;
+            cp_ = other.cp_;
+            head_ = other.head_;
+            bound_ = other.bound_;
+            data_ = other.data_;
+            other.sz_ = 0;
+            other.cp_ = 0;
+            other.head_ = 0;
+            other.bound_ = 0;
+            other.data_ = nullptr;
+        }
+        else {
+            AssignElements(other, [](reference val) -> T&& { return std::move(val); });
+        }
+        return *this;
+    }
+
+    constexpr allocator_type get_allocator() const noexcept {
+        return allocator_;
+    }
+
+    constexpr reference at(size_type pos) {
+        if (pos >= sz_) throw std::out_of_range("RingVector::at");
+        return data_[Physical(pos)];
+    }
+
+    constexpr const_reference at(size_type pos) const {
+        if (pos >= sz_) throw std::out_of_range("RingVector::at");
+        return data_[Physical(pos)];
+    }
+
+    constexpr reference operator[](size_type pos) noexcept {
+        return data_[Physical(pos)];
+    }
+
+    constexpr const_reference operator[](size_type pos) const noexcept {
+        return data_[Physical(pos)];
+    }
+
+    constexpr reference front() noexcept {
+        return data_[head_];
+    }
+
+    constexpr const_reference front() const noexcept {
+        return data_[head_];
+    }
+
+    constexpr reference back() noexcept {
+        return data_[Physical(sz_ - 1)];
+    }
+
+    constexpr const_reference back() const noexcept {
+        return data_[Physical(sz_ - 1)];
+    }
+
+    constexpr bool empty() const noexcept {
+        return sz_ == 0;
+    }
+
+    constexpr size_type size() const noexcept {
+        return sz_;
+    }
+
+    constexpr size_type max_size() const noexcept {
+        return std::allocator_traits<allocator_type>::max_size(allocator_);
+    }
+
+    constexpr size_type capacity() const noexcept {
+        return cp_;
+    }
+
+    constexpr void reserve(size_type new_cap) {
+        if (new_cap <= cp_ || bound_ != 0) return;
+        if (new_cap >= max_size()) throw std::length_error("RingVector::reserve");
+        Relocate(new_cap);
+    }
+
+    // Fixes the capacity to bound; a push into a full ring then overwrites the
+    // oldest element at the other end. If more than bound elements are stored,
+    // the front ones are dropped. bound == 0 returns to unbounded growth.
+    constexpr void set_bound(size_type bound) {
+        if (bound >= max_size()) throw std::length_error("RingVector::set_bound");
+        if (bound != 0) {
+            while (sz_ > bound) pop_front();
+            if (bound != cp_) Relocate(bound);
+        }
+        bound_ = bound;
+    }
+
+    constexpr size_type bound() const noexcept {
+        return bound_;
+    }
+
+    // Makes the elements contiguous, starting at the beginning of the buffer,
+    // and returns a view of them. Valid until the next modification.
+    constexpr std::span<value_type> linearize() {
+        if (head_ + sz_ > cp_) {
+            if constexpr (std::is_nothrow_swappable_v<value_type>) {
+                if (sz_ == cp_) {
+                    std::rotate(std::to_address(data_), std::to_address(data_ + head_), std::to_address(data_ + cp_));
+                    head_ = 0;
+                    return std::span<value_type>(std::to_address(data_), sz_);
+                }
+            }
+            Relocate(cp_);
+        }
+        return std::span<value_type>(std::to_address(data_ + head_), sz_);
+    }
+
+    constexpr iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    constexpr iterator end() noexcept {
+        return iterator(this, sz_);
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return const_iterator(this, sz_);
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return const_iterator(this, sz_);
+    }
+
+    constexpr reverse_iterator rbegin() noexcept {
+        return std::make_reverse_iterator(end());
+    }
+
+    constexpr const_reverse_iterator rbegin() const noexcept {
+        return std::make_reverse_iterator(cend());
+    }
+
+    constexpr reverse_iterator rend() noexcept {
+        return std::make_reverse_iterator(begin());
+    }
+
+    constexpr const_reverse_iterator rend() const noexcept {
+        return std::make_reverse_iterator(cbegin());
+    }
+
+    constexpr void clear() noexcept {
+        for (size_type idx = 0; idx < sz_; ++idx) {
+            std::allocator_traits<allocator_type>::destroy(allocator_, std::to_address(data_ + Physical(idx)));
+        }
+        sz_ = 0;
+        head_ = 0;
+    }
+
+    constexpr void push_back(const_reference val) {
+        emplace_back(val);
+    }
+
+    constexpr void push_back(T&& val) {
+        emplace_back(std::move(val));
+    }
+
+    constexpr void push_front(const_reference val) {
+        emplace_front(val);
+    }
+
+    constexpr void push_front(T&& val) {
+        emplace_front(std::move(val));
+    }
+
+    template<typename... Args>
+    constexpr reference emplace_back(Args&&... args) {
+        if (sz_ == cp_ && bound_ != 0) {
+            value_type val(myforward::forward<Args>(args)...);
+            pop_front();
+            return emplace_back(std::move(val));
+        }
+        if (sz_ == cp_) {
+            return GrowAndEmplace(false, myforward::forward<Args>(args)...);
+        }
+        pointer slot = data_ + Physical(sz_);
+        std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(slot), myforward::forward<Args>(args)...);
+        ++sz_;
+        return *slot;
+    }
+
+    template<typename... Args>
+    constexpr reference emplace_front(Args&&... args) {
+        if (sz_ == cp_ && bound_ != 0) {
+            value_type val(myforward::forward<Args>(args)...);
+            pop_back();
+            return emplace_front(std::move(val));
+        }
+        if (sz_ == cp_) {
+            return GrowAndEmplace(true, myforward::forward<Args>(args)...);
+        }
+        size_type new_head = head_ == 0 ? cp_ - 1 : head_ - 1;
+        std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(data_ + new_head), myforward::forward<Args>(args)...);
+        head_ = new_head;
+        ++sz_;
+        return data_[head_];
+    }
+
+    constexpr void pop_back() noexcept {
+        --sz_;
+        std::allocator_traits<allocator_type>::destroy(allocator_, std::to_address(data_ + Physical(sz_)));
+    }
+
+    constexpr void pop_front() noexcept {
+        std::allocator_traits<allocator_type>::destroy(allocator_, std::to_address(data_ + head_));
+        head_ = head_ + 1 == cp_ ? 0 : head_ + 1;
+        --sz_;
+    }
+
+    constexpr void swap(RingVector& other)
+    noexcept(std::allocator_traits<Allocator>::propagate_on_container_swap::value ||
+             std::allocator_traits<Allocator>::is_always_equal::value) {
+        if (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+            std::swap(allocator_, other.allocator_);
+        }
+        std::swap(sz_, other.sz_);
+        std::swap(cp_, other.cp_);
+        std::swap(head_, other.head_);
+        std::swap(bound_, other.bound_);
+        std::swap(data_, other.data_);
+    }
+
+    private:
+
+    allocator_type allocator_;
+    size_type sz_;
+    size_type cp_;
+    size_type head_;
+    size_type bound_;
+    pointer data_;
+
+    constexpr void ReleaseStorage() noexcept {
+        clear();
+        if (data_ != nullptr) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+        }
+        data_ = nullptr;
+        cp_ = 0;
+    }
+
+    // Replaces the contents element by element with get(other[idx]), keeping
+    // this ring's buffer and allocator, then takes over other's bound.
+    template<typename Source, typename Get>
+    constexpr void AssignElements(Source& other, Get get) {
+        clear();
+        bound_ = 0;
+        reserve(other.sz_);
+        for (size_type idx = 0; idx < other.sz_; ++idx) {
+            emplace_back(get(other[idx]));
+        }
+        set_bound(other.bound_);
+    }
+
+    constexpr size_type Physical(size_type pos) const noexcept {
+        size_type idx = head_ + pos;
+        return idx >= cp_ ? idx - cp_ : idx;
+    }
+
+    // Moves the elements to a new buffer of new_cap >= sz_ elements, front first.
+    constexpr void Relocate(size_type new_cap) {
+        pointer new_data = std::allocator_traits<allocator_type>::allocate(allocator_, new_cap);
+        try {
+            MoveInto(new_data);
+        }
+        catch (...) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, new_data, new_cap);
+            throw;
+        }
+        Install(new_data, new_cap);
+    }
+
+    // Doubles the capacity for one more element. The new element is built
+    // in the new buffer before the old ones move, so args may refer to them
+    // (as in q.push_back(q.front())).
+    template<typename... Args>
+    constexpr reference GrowAndEmplace(bool front, Args&&... args) {
+        size_type new_cap = cp_ == 0 ? 2 : cp_ * 2;
+        size_type slot = front ? new_cap - 1 : sz_;
+        pointer new_data = std::allocator_traits<allocator_type>::allocate(allocator_, new_cap);
+        try {
+            std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(new_data + slot),
+                                                             myforward::forward<Args>(args)...);
+        }
+        catch (...) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, new_data, new_cap);
+            throw;
+        }
+        try {
+            MoveInto(new_data);
+        }
+        catch (...) {
+            std::allocator_traits<allocator_type>::destroy(allocator_, std::to_address(new_data + slot));
+            std::allocator_traits<allocator_type>::deallocate(allocator_, new_data, new_cap);
+            throw;
+        }
+        Install(new_data, new_cap);
+        if (front) head_ = slot;
+        ++sz_;
+        return new_data[slot];
+    }
+
+    // Moves (or copies) the elements to [0, size) of new_data. If that
+    // throws, the ones already built there are destroyed again.
+    constexpr void MoveInto(pointer new_data) {
+        size_type done = 0;
+        try {
+            for (; done < sz_; ++done) {
+                std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(new_data + done),
+                                                                 std::move_if_noexcept((*this)[done]));
+            }
+        }
+        catch (...) {
+            for (size_type idx = 0; idx < done; ++idx) {
+                std::allocator_traits<allocator_type>::destroy(allocator_, std::to_address(new_data + idx));
+            }
+            throw;
+        }
+    }
+
+    // Frees the current buffer and takes new_data, whose [0, size) MoveInto
+    // filled.
+    constexpr void Install(pointer new_data, size_type new_cap) noexcept {
+        size_type count = sz_;
+        clear();
+        if (data_ != nullptr) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+        }
+        data_ = new_data;
+        cp_ = new_cap;
+        sz_ = count;
+    }
+};
+
+} // namespace myvector
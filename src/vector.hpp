@@ -1,15 +1,44 @@
+#pragma once
 #include <memory>
 #include <iterator>
 #include <type_traits>
 #include <utility>
+#include <stdexcept>
+#include <concepts>
 #include "forward.hpp"
+#include "vector_expr.hpp"
 #include <iostream>
 #include <initializer_list>
+#include <span>
 
 namespace myvector {
 
 using myforward::forward;
 
+// Non-owning view of contiguous elements, e.g. of a Vector.
+template<typename T>
+using VectorView = std::span<T>;
+
+// Automatic capacity shrinking. Once size drops below threshold * capacity,
+// capacity is multiplied by factor until the vector fills at least threshold
+// of it again. threshold == 0 disables shrinking. The policy belongs to the
+// vector object: copies, moves, assignments and swaps never transfer it, so a
+// new vector always starts with the default.
+struct ShrinkPolicy {
+    float threshold = 0;
+    float factor = 0.5f;
+};
+
+// Allocators may provide
+//     size_type shrink_in_place(pointer p, size_type n, size_type new_n)
+// that returns the tail of an n-element buffer to the system without moving it
+// and reports the capacity actually kept (new_n <= result <= n).
+template<typename Allocator>
+concept InPlaceShrinkable = requires(Allocator& alloc, typename std::allocator_traits<Allocator>::pointer ptr,
+                                     typename std::allocator_traits<Allocator>::size_type n) {
+    { alloc.shrink_in_place(ptr, n, n) } -> std::convertible_to<typename std::allocator_traits<Allocator>::size_type>;
+};
+
 
 template<typename T, typename Allocator = std::allocator<T>>
 class Vector {
@@ -42,6 +71,8 @@ class Vector {
 
         constexpr VecIter(const VecIter& other) noexcept: ptr_(other.ptr_) {}
 
+        constexpr VecIter(const VecIter<false>& other) noexcept requires Const: ptr_(other.ptr_) {}
+
         constexpr VecIter& operator=(const VecIter& other) noexcept {
             ptr_ = other.ptr_;
             return *this;
@@ -133,23 +164,35 @@ class Vector {
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+    // Storage handed out by release() and accepted by adopt(): capacity
+    // elements allocated by the vector's allocator, the first size of them
+    // constructed.
+    struct buffer_type {
+        pointer data;
+        size_type size;
+        size_type capacity;
+    };
+
     constexpr Vector() noexcept(noexcept(allocator_type())):
         allocator_(),
         sz_(0),
         cp_(0),
-        data_(nullptr) {}
+        data_(nullptr),
+        shrink_policy_() {}
 
     constexpr explicit Vector(const allocator_type& alloc) noexcept:
         allocator_(alloc),
         sz_(0),
         cp_(0),
-        data_(nullptr) {}
+        data_(nullptr),
+        shrink_policy_() {}
 
     constexpr Vector(size_type count, const T& value, const allocator_type& alloc = allocator_type()):
         allocator_(alloc),
         sz_(count),
         cp_(count),
-        data_(nullptr)
+        data_(nullptr),
+        shrink_policy_()
         {
             data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
             Fill(allocator_, begin(), begin() + sz_, value);
@@ -159,7 +202,8 @@ class Vector {
         allocator_(alloc),
         sz_(count),
         cp_(count),
-        data_(nullptr)
+        data_(nullptr),
+        shrink_policy_()
         {
             data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
             Fill(allocator_, begin(), end());
@@ -170,7 +214,8 @@ class Vector {
         allocator_(alloc),
         sz_(std::distance(first, last)),
         cp_(sz_),
-        data_(nullptr) {
+        data_(nullptr),
+        shrink_policy_() {
             data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
             iterator dst(data_);
             for(;first != last; ++first) {
@@ -182,7 +227,8 @@ class Vector {
         allocator_(std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.allocator_)),
         sz_(other.sz_),
         cp_(other.sz_),
-        data_(nullptr)
+        data_(nullptr),
+        shrink_policy_()
         {
             data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
             Copy(allocator_, other.cbegin(), other.cend(), begin());
@@ -192,7 +238,8 @@ class Vector {
         allocator_(alloc),
         sz_(other.sz_),
         cp_(other.sz_),
-        data_(nullptr)
+        data_(nullptr),
+        shrink_policy_()
         {
             data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
             Copy(allocator_, other.cbegin(), other.cend(), begin());
@@ -202,7 +249,8 @@ class Vector {
         allocator_(std::move(other.allocator_)),
         sz_(other.sz_),
         cp_(other.cp_),
-        data_(other.data_)
+        data_(other.data_),
+        shrink_policy_()
         {
             other.cp_ = 0;
             other.sz_ = 0;
@@ -213,7 +261,8 @@ class Vector {
         allocator_(alloc),
         sz_(other.sz_),
         cp_(other.cp_),
-        data_(nullptr)
+        data_(nullptr),
+        shrink_policy_()
         {
             if (allocator_ == other.allocator_) {
                 data_ = other.data_;
@@ -231,7 +280,8 @@ class Vector {
         allocator_(alloc),
         sz_(init.size()),
         cp_(init.size()),
-        data_(nullptr)
+        data_(nullptr),
+        shrink_policy_()
         {
             data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
             iterator dst(data_);
@@ -240,8 +290,22 @@ class Vector {
             }
         }
     
+    template<VectorExpression Expr>
+    constexpr Vector(const Expr& expr, const allocator_type& alloc = allocator_type()):
+        allocator_(alloc),
+        sz_(expr.size()),
+        cp_(expr.size()),
+        data_(nullptr),
+        shrink_policy_()
+        {
+            data_ = std::allocator_traits<allocator_type>::allocate(allocator_, cp_);
+            for (size_type idx = 0; idx < sz_; ++idx) {
+                std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(data_ + idx), expr[idx]);
+            }
+        }
+
     ~Vector() {
-        clear();
+        Destroy(allocator_, begin(), end());
         if (data_ != nullptr) {
             std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
         }
@@ -272,6 +336,7 @@ class Vector {
             else Destroy(allocator_, begin() + other.sz_, end());
         
             sz_ = other.sz_;
+            MaybeShrink();
         }
 
         return *this;
@@ -312,6 +377,7 @@ class Vector {
             else Destroy(allocator_, begin() + other.sz_, end());
         
             sz_ = other.sz_;
+            MaybeShrink();
         }
 
         return *this;
@@ -341,9 +407,77 @@ class Vector {
         else Destroy(allocator_, begin() + (int)ilist.size(), end());
 
         sz_ = ilist.size();
+        MaybeShrink();
         return *this;
     }
 
+    // Evaluates expr element by element in a single pass. The vector may
+    // itself appear in expr: every element only reads the same index.
+    template<VectorExpression Expr>
+    constexpr Vector& operator=(const Expr& expr) {
+        size_type count = expr.size();
+        if (count > cp_) {
+            pointer new_data = std::allocator_traits<allocator_type>::allocate(allocator_, count);
+            for (size_type idx = 0; idx < count; ++idx) {
+                std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(new_data + idx), expr[idx]);
+            }
+            Destroy(allocator_, begin(), end());
+            if (data_ != nullptr) {
+                std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+            }
+            data_ = new_data;
+            cp_ = count;
+            sz_ = count;
+            return *this;
+        }
+
+        size_type minsz = sz_ < count ? sz_ : count;
+        EvaluateExpr(std::to_address(data_), expr, 0, minsz);
+        for (size_type idx = sz_; idx < count; ++idx) {
+            std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(data_ + idx), expr[idx]);
+        }
+        if (count < sz_) Destroy(allocator_, begin() + (int)count, end());
+
+        sz_ = count;
+        MaybeShrink();
+        return *this;
+    }
+
+    // Same as operator=(expr), but large expressions are split into chunks
+    // evaluated on up to threads threads (0 means hardware concurrency).
+    template<VectorExpression Expr>
+    void assign_parallel(const Expr& expr, unsigned threads = 0) {
+        size_type count = expr.size();
+        if (count > cp_) {
+            pointer new_data = std::allocator_traits<allocator_type>::allocate(allocator_, count);
+            try {
+                ForEachChunkParallel(count, threads, [&](size_type first, size_type last) {
+                    StoreExpr(new_data, expr, 0, first, last);
+                });
+            }
+            catch (...) {
+                std::allocator_traits<allocator_type>::deallocate(allocator_, new_data, count);
+                throw;
+            }
+            Destroy(allocator_, begin(), end());
+            if (data_ != nullptr) {
+                std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+            }
+            data_ = new_data;
+            cp_ = count;
+            sz_ = count;
+            return;
+        }
+
+        ForEachChunkParallel(count, threads, [&](size_type first, size_type last) {
+            StoreExpr(data_, expr, sz_, first, last);
+        });
+        if (count < sz_) Destroy(allocator_, begin() + (int)count, end());
+
+        sz_ = count;
+        MaybeShrink();
+    }
+
     constexpr allocator_type get_allocator() const noexcept {
         return allocator_;
     }
@@ -390,6 +524,64 @@ class Vector {
         return data_;
     }
 
+    constexpr VectorView<value_type> view() noexcept {
+        return VectorView<value_type>(std::to_address(data_), sz_);
+    }
+
+    constexpr VectorView<const value_type> view() const noexcept {
+        return VectorView<const value_type>(std::to_address(data_), sz_);
+    }
+
+    constexpr operator VectorView<value_type>() noexcept {
+        return view();
+    }
+
+    constexpr operator VectorView<const value_type>() const noexcept {
+        return view();
+    }
+
+    // Takes ownership of an external buffer without copying it. The buffer
+    // must come from an allocator that compares equal to get_allocator();
+    // source names it so debug builds can check. The current contents are
+    // destroyed; re-adopting the own buffer keeps the first size elements
+    // and the current capacity.
+    constexpr void adopt(pointer data, size_type size, size_type capacity, const allocator_type& source) {
+#ifdef _DEBUG
+        if (size > capacity || (data == nullptr) != (capacity == 0) || !(source == allocator_) ||
+            (data != nullptr && data == data_ && (size > sz_ || capacity != cp_))) {
+            throw std::invalid_argument("Vector::adopt");
+        }
+#else
+        (void)source;
+#endif
+        if (data == data_) {
+            if (size < sz_) Destroy(allocator_, begin() + (int)size, end());
+            sz_ = size;
+            return;
+        }
+        Destroy(allocator_, begin(), end());
+        if (data_ != nullptr) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+        }
+        data_ = data;
+        sz_ = size;
+        cp_ = capacity;
+    }
+
+    constexpr void adopt(const buffer_type& buffer, const allocator_type& source) {
+        adopt(buffer.data, buffer.size, buffer.capacity, source);
+    }
+
+    // Gives up ownership of the storage and leaves the vector empty. The
+    // caller destroys the elements and deallocates with get_allocator().
+    constexpr buffer_type release() noexcept {
+        buffer_type buffer = {data_, sz_, cp_};
+        data_ = nullptr;
+        sz_ = 0;
+        cp_ = 0;
+        return buffer;
+    }
+
 
     constexpr bool empty() const noexcept {
         return sz_ == 0;
@@ -445,23 +637,32 @@ class Vector {
 
     constexpr void shrink_to_fit() {
         if (sz_ == cp_) return;
+        Relocate(sz_);
+    }
 
+    // Releases unused capacity without moving the elements. Only allocators
+    // that provide shrink_in_place support this; returns false otherwise.
+    constexpr bool shrink_to_fit_in_place() {
+        if (sz_ == cp_) return false;
         if (sz_ == 0) {
-            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
-            cp_ = 0;
-            data_ = nullptr;
-            return;
+            Relocate(0);
+            return true;
         }
+        return ShrinkInPlace(sz_);
+    }
 
-        pointer new_data = std::allocator_traits<allocator_type>::allocate(allocator_, sz_);
-        Move(allocator_, begin(), end(), iterator(new_data));
-        Destroy(allocator_, begin(), end());
-        if (data_ != nullptr) {
-            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+    constexpr void set_shrink_policy(const ShrinkPolicy& policy) {
+        // Written so that NaN fails every comparison and is rejected.
+        if (!(policy.threshold >= 0 && policy.threshold < 0.5f) ||
+            (policy.threshold > 0 && !(policy.factor > policy.threshold && policy.factor < 1))) {
+            throw std::invalid_argument("Vector::set_shrink_policy");
         }
+        shrink_policy_ = policy;
+        MaybeShrink();
+    }
 
-        data_ = new_data;
-        cp_ = sz_;
+    constexpr ShrinkPolicy shrink_policy() const noexcept {
+        return shrink_policy_;
     }
 
     constexpr iterator begin() noexcept {
@@ -516,6 +717,7 @@ class Vector {
     constexpr void clear() noexcept {
         Destroy(allocator_, begin(), end());
         sz_ = 0;
+        MaybeShrink();
     }
 
     constexpr iterator insert(const_iterator position, const_reference val) {
@@ -565,11 +767,12 @@ class Vector {
     }
 
     constexpr iterator erase(const_iterator position) {
-        iterator pos = position;
-        MoveAssign(pos + 1, end(), pos);
+        difference_type dif = position - cbegin();
+        MoveAssign(begin() + (int)dif + 1, end(), begin() + (int)dif);
         --sz_;
-        std::allocator_traits<allocator_type>::destroy(allocator_, end());
-        return pos;
+        std::allocator_traits<allocator_type>::destroy(allocator_, end().ptr_);
+        MaybeShrink();
+        return begin() + (int)dif;
     }
 
     constexpr void push_back(const_reference val) {
@@ -587,31 +790,34 @@ class Vector {
 
     constexpr void pop_back() noexcept {
         --sz_;
-        std::allocator_traits<allocator_type>::destroy(allocator_, end());
+        std::allocator_traits<allocator_type>::destroy(allocator_, end().ptr_);
+        MaybeShrink();
     }
 
     constexpr void resize(size_type count) {
         if (count > max_size()) throw std::length_error("Vector::resize");
         if (count < sz_) {
-            Destroy(allocator_, begin() + count, end());
+            Destroy(allocator_, begin() + (int)count, end());
         }
         else {
             reserve(count);
-            Fill(allocator_, end(), begin() + count);
+            Fill(allocator_, end(), begin() + (int)count);
         }
         sz_ = count;
+        MaybeShrink();
     }
 
     constexpr void resize(size_type count, const_reference val) {
         if (count > max_size()) throw std::length_error("Vector::resize");
         if (count < sz_) {
-            Destroy(allocator_, begin() + count, end());
+            Destroy(allocator_, begin() + (int)count, end());
         }
         else {
             reserve(count);
-            Fill(allocator_, end(), begin() + count, val);
+            Fill(allocator_, end(), begin() + (int)count, val);
         }
         sz_ = count;
+        MaybeShrink();
     }
 
     constexpr void swap(Vector& other)
@@ -637,6 +843,67 @@ class Vector {
     size_type sz_;
     size_type cp_;
     pointer data_;
+    ShrinkPolicy shrink_policy_;
+
+    // Writes expr[first, last) to out: elements below constructed are
+    // assigned, the rest are constructed in place.
+    template<VectorExpression Expr>
+    constexpr void StoreExpr(pointer out, const Expr& expr, size_type constructed, size_type first, size_type last) {
+        size_type mid = constructed < first ? first : (constructed < last ? constructed : last);
+        EvaluateExpr(std::to_address(out), expr, first, mid);
+        for (size_type idx = mid; idx < last; ++idx) {
+            std::allocator_traits<allocator_type>::construct(allocator_, std::to_address(out + idx), expr[idx]);
+        }
+    }
+
+    constexpr void Relocate(size_type new_cap) {
+        pointer new_data = nullptr;
+        if (new_cap != 0) {
+            new_data = std::allocator_traits<allocator_type>::allocate(allocator_, new_cap);
+            Move(allocator_, begin(), end(), iterator(new_data));
+        }
+        Destroy(allocator_, begin(), end());
+        if (data_ != nullptr) {
+            std::allocator_traits<allocator_type>::deallocate(allocator_, data_, cp_);
+        }
+
+        data_ = new_data;
+        cp_ = new_cap;
+    }
+
+    constexpr bool ShrinkInPlace(size_type new_cap) {
+        if constexpr (InPlaceShrinkable<allocator_type>) {
+            size_type kept = allocator_.shrink_in_place(data_, cp_, new_cap);
+            if (kept == cp_) return false;
+            cp_ = kept;
+            return true;
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Geometric shrink with hysteresis: the resulting capacity keeps size at
+    // or above threshold * capacity, so a vector that just doubled (or shrank)
+    // is not resized again until it moves past the opposite boundary.
+    constexpr void MaybeShrink() noexcept {
+        double threshold = shrink_policy_.threshold;
+        if (threshold <= 0 || (double)sz_ >= (double)cp_ * threshold) return;
+
+        size_type new_cap = cp_;
+        do {
+            new_cap = (size_type)((double)new_cap * shrink_policy_.factor);
+        } while ((double)sz_ < (double)new_cap * threshold);
+        if (new_cap < sz_) new_cap = sz_;
+
+        try {
+            if (new_cap != 0 && ShrinkInPlace(new_cap)) return;
+            if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
+                Relocate(new_cap);
+            }
+        }
+        catch (...) {}
+    }
 
 
     static void Copy(allocator_type allocator, iterator src, iterator src_end, iterator dst) {
@@ -0,0 +1,274 @@
+#pragma once
+#include <cstddef>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace myvector {
+
+// Lazy element-wise arithmetic over numeric Vectors. Operators build a tree of
+// expression nodes that is evaluated only when assigned to a Vector, in one
+// loop over the elements and without temporary buffers.
+
+template<typename T, typename Allocator>
+class Vector;
+
+struct ExprNode {};
+
+template<typename T>
+struct ExprTerminal: ExprNode {
+    using value_type = T;
+
+    constexpr ExprTerminal(const T* data, std::size_t size) noexcept: data_(data), sz_(size) {}
+
+    constexpr value_type operator[](std::size_t idx) const noexcept {
+        return data_[idx];
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return sz_;
+    }
+
+    static constexpr bool is_scalar = false;
+
+    const T* data_;
+    std::size_t sz_;
+};
+
+template<typename T>
+struct ExprScalar: ExprNode {
+    using value_type = T;
+
+    constexpr explicit ExprScalar(T value) noexcept: val_(value) {}
+
+    constexpr value_type operator[](std::size_t) const noexcept {
+        return val_;
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return 0;
+    }
+
+    static constexpr bool is_scalar = true;
+
+    T val_;
+};
+
+template<typename Op, typename L, typename R>
+struct ExprBinary: ExprNode {
+    using value_type = decltype(Op()(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()));
+
+    constexpr ExprBinary(const L& lhs, const R& rhs):
+        lhs_(lhs),
+        rhs_(rhs),
+        sz_(L::is_scalar ? rhs.size() : lhs.size())
+        {
+            if (!L::is_scalar && !R::is_scalar && lhs.size() != rhs.size()) {
+                throw std::length_error("Vector expression: size mismatch");
+            }
+        }
+
+    constexpr value_type operator[](std::size_t idx) const {
+        return Op()(lhs_[idx], rhs_[idx]);
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return sz_;
+    }
+
+    static constexpr bool is_scalar = L::is_scalar && R::is_scalar;
+
+    L lhs_;
+    R rhs_;
+    std::size_t sz_;
+};
+
+template<typename Op, typename E>
+struct ExprUnary: ExprNode {
+    using value_type = decltype(Op()(std::declval<typename E::value_type>()));
+
+    constexpr explicit ExprUnary(const E& arg): arg_(arg) {}
+
+    constexpr value_type operator[](std::size_t idx) const {
+        return Op()(arg_[idx]);
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return arg_.size();
+    }
+
+    static constexpr bool is_scalar = E::is_scalar;
+
+    E arg_;
+};
+
+namespace ops {
+
+struct Plus { template<typename A, typename B> constexpr auto operator()(A a, B b) const { return a + b; } };
+struct Minus { template<typename A, typename B> constexpr auto operator()(A a, B b) const { return a - b; } };
+struct Multiplies { template<typename A, typename B> constexpr auto operator()(A a, B b) const { return a * b; } };
+struct Divides { template<typename A, typename B> constexpr auto operator()(A a, B b) const { return a / b; } };
+struct Pow { template<typename A, typename B> auto operator()(A a, B b) const { return std::pow(a, b); } };
+
+struct Negate { template<typename A> constexpr auto operator()(A a) const { return -a; } };
+struct Sqrt { template<typename A> auto operator()(A a) const { return std::sqrt(a); } };
+struct Exp { template<typename A> auto operator()(A a) const { return std::exp(a); } };
+struct Log { template<typename A> auto operator()(A a) const { return std::log(a); } };
+struct Sin { template<typename A> auto operator()(A a) const { return std::sin(a); } };
+struct Cos { template<typename A> auto operator()(A a) const { return std::cos(a); } };
+struct Abs { template<typename A> auto operator()(A a) const { return std::abs(a); } };
+
+} // namespace ops
+
+template<typename E>
+concept VectorExpression = std::is_base_of_v<ExprNode, E>;
+
+template<typename T>
+struct IsNumericVector: std::false_type {};
+
+template<typename T, typename Allocator>
+struct IsNumericVector<Vector<T, Allocator>>: std::bool_constant<std::is_arithmetic_v<T>> {};
+
+template<typename X>
+concept ExprOperand = VectorExpression<X> || IsNumericVector<X>::value;
+
+template<typename X>
+concept ExprArgument = ExprOperand<X> || std::is_arithmetic_v<X>;
+
+template<typename X>
+constexpr auto AsExpr(const X& arg) {
+    if constexpr (VectorExpression<X>) {
+        return arg;
+    }
+    else if constexpr (std::is_arithmetic_v<X>) {
+        return ExprScalar<X>(arg);
+    }
+    else {
+        return ExprTerminal<typename X::value_type>(std::to_address(arg.data()), arg.size());
+    }
+}
+
+template<typename Op, typename L, typename R>
+constexpr auto MakeBinary(const L& lhs, const R& rhs) {
+    using LE = decltype(AsExpr(lhs));
+    using RE = decltype(AsExpr(rhs));
+    return ExprBinary<Op, LE, RE>(AsExpr(lhs), AsExpr(rhs));
+}
+
+template<typename Op, typename E>
+constexpr auto MakeUnary(const E& arg) {
+    return ExprUnary<Op, decltype(AsExpr(arg))>(AsExpr(arg));
+}
+
+template<ExprArgument L, ExprArgument R> requires (ExprOperand<L> || ExprOperand<R>)
+constexpr auto operator+(const L& lhs, const R& rhs) {
+    return MakeBinary<ops::Plus>(lhs, rhs);
+}
+
+template<ExprArgument L, ExprArgument R> requires (ExprOperand<L> || ExprOperand<R>)
+constexpr auto operator-(const L& lhs, const R& rhs) {
+    return MakeBinary<ops::Minus>(lhs, rhs);
+}
+
+template<ExprArgument L, ExprArgument R> requires (ExprOperand<L> || ExprOperand<R>)
+constexpr auto operator*(const L& lhs, const R& rhs) {
+    return MakeBinary<ops::Multiplies>(lhs, rhs);
+}
+
+template<ExprArgument L, ExprArgument R> requires (ExprOperand<L> || ExprOperand<R>)
+constexpr auto operator/(const L& lhs, const R& rhs) {
+    return MakeBinary<ops::Divides>(lhs, rhs);
+}
+
+template<ExprArgument L, ExprArgument R> requires (ExprOperand<L> || ExprOperand<R>)
+auto pow(const L& base, const R& exponent) {
+    return MakeBinary<ops::Pow>(base, exponent);
+}
+
+template<ExprOperand E>
+constexpr auto operator-(const E& arg) {
+    return MakeUnary<ops::Negate>(arg);
+}
+
+template<ExprOperand E>
+auto sqrt(const E& arg) {
+    return MakeUnary<ops::Sqrt>(arg);
+}
+
+template<ExprOperand E>
+auto exp(const E& arg) {
+    return MakeUnary<ops::Exp>(arg);
+}
+
+template<ExprOperand E>
+auto log(const E& arg) {
+    return MakeUnary<ops::Log>(arg);
+}
+
+template<ExprOperand E>
+auto sin(const E& arg) {
+    return MakeUnary<ops::Sin>(arg);
+}
+
+template<ExprOperand E>
+auto cos(const E& arg) {
+    return MakeUnary<ops::Cos>(arg);
+}
+
+template<ExprOperand E>
+auto abs(const E& arg) {
+    return MakeUnary<ops::Abs>(arg);
+}
+
+// Assigns expr[first, last) to already constructed elements of out. The tree
+// is copied (it only holds pointers and scalars) so that stores through out
+// cannot alias it and the loop can be vectorized.
+template<typename T, VectorExpression Expr>
+constexpr void EvaluateExpr(T* out, const Expr& expr, std::size_t first, std::size_t last) {
+    const Expr local = expr;
+    for (std::size_t idx = first; idx < last; ++idx) {
+        out[idx] = local[idx];
+    }
+}
+
+// Elements per thread below which splitting the loop does not pay off.
+constexpr std::size_t kParallelExprGrain = std::size_t(1) << 15;
+
+// Calls func(first, last) on up to threads contiguous chunks of [0, count)
+// (0 means hardware concurrency), one of them on the calling thread.
+template<typename Func>
+void ForEachChunkParallel(std::size_t count, unsigned threads, Func func) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    std::size_t chunks = count / kParallelExprGrain;
+    if (chunks > threads) chunks = threads;
+    if (chunks <= 1) {
+        func(std::size_t(0), count);
+        return;
+    }
+
+    std::size_t step = (count + chunks - 1) / chunks;
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    try {
+        for (std::size_t first = step; first < count; first += step) {
+            std::size_t last = first + step < count ? first + step : count;
+            workers.emplace_back([&func, first, last] { func(first, last); });
+        }
+        func(std::size_t(0), step);
+    }
+    catch (...) {
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        throw;
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace myvector